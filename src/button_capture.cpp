@@ -0,0 +1,204 @@
+#include "button_capture.h"
+
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+
+#include "hot_path.h"
+
+// Must be a power of two
+#define EDGE_BUFFER_SIZE 64
+
+static button_edge_t edge_buffer[EDGE_BUFFER_SIZE];
+// head is only written by the IRQ, tail only by the main loop
+static volatile uint32_t edge_head = 0;
+static volatile uint32_t edge_tail = 0;
+static volatile uint32_t edge_dropped = 0;
+
+// time_us_32() of the last accepted edge per pin, IRQ written
+static volatile uint32_t accepted_us[32];
+// State as the IRQ last saw it, used to drop repeated edges in one direction
+static uint32_t irq_state = 0;
+
+static uint32_t button_mask = 0;
+static uint32_t button_state = 0;   // pressed pins after the last drained edge
+static uint32_t latched_press = 0;  // presses not yet carried by a report
+static bool edge_pending = false;   // an edge has not been carried by a report yet
+static uint32_t pending_edge_us = 0; // time of the first such edge
+static uint32_t seen_dropped = 0;
+
+static uint32_t last_latency_us = 0;
+static uint32_t max_latency_us = 0;
+
+static void HOT_PATH_FUNC(button_edge)(uint gpio, uint32_t events)
+{
+    uint32_t bit = 1u << gpio;
+    uint32_t now = time_us_32();
+    if (now - accepted_us[gpio] < BUTTON_DEBOUNCE_US)
+        return;
+
+    // Both edges latched before we got here: fall back to the level
+    bool pressed;
+    if ((events & GPIO_IRQ_EDGE_FALL) && (events & GPIO_IRQ_EDGE_RISE))
+        pressed = !gpio_get(gpio);
+    else
+        pressed = (events & GPIO_IRQ_EDGE_FALL) != 0;
+
+    if (pressed == ((irq_state & bit) != 0))
+        return;
+
+    uint32_t head = edge_head;
+    if (head - edge_tail >= EDGE_BUFFER_SIZE)
+    {
+        edge_dropped = edge_dropped + 1;
+        return;
+    }
+
+    accepted_us[gpio] = now;
+    irq_state ^= bit;
+
+    button_edge_t *edge = &edge_buffer[head & (EDGE_BUFFER_SIZE - 1)];
+    edge->time_us = now;
+    edge->pin = (uint8_t)gpio;
+    edge->pressed = pressed;
+
+    // Publish the entry before moving head
+    __compiler_memory_barrier();
+    edge_head = head + 1;
+}
+
+// Raw IO_IRQ_BANK0 handler for the button pins only, so the SDK's GPIO
+// callback dispatcher is not involved. Only uses the inline event helpers.
+static void HOT_PATH_FUNC(button_irq_handler)(void)
+{
+    uint32_t pins = button_mask;
+    for (uint gpio = 0; pins != 0; gpio++, pins >>= 1)
+    {
+        if (!(pins & 1u))
+            continue;
+
+        uint32_t events = gpio_get_irq_event_mask(gpio);
+        if (!events)
+            continue;
+
+        gpio_acknowledge_irq(gpio, events);
+        button_edge(gpio, events);
+    }
+}
+
+void button_capture_init(uint32_t pin_mask)
+{
+    const uint32_t events = GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL;
+
+    button_mask = pin_mask;
+    button_state = ~gpio_get_all() & button_mask;
+    irq_state = button_state;
+
+    gpio_add_raw_irq_handler_masked(pin_mask, &button_irq_handler);
+    for (uint pin = 0; pin < 32; pin++)
+    {
+        if (pin_mask & (1u << pin))
+            gpio_set_irq_enabled(pin, events, true);
+    }
+    irq_set_enabled(IO_IRQ_BANK0, true);
+}
+
+void HOT_PATH_FUNC(button_capture_update)(void)
+{
+    uint32_t head = edge_head;
+    __compiler_memory_barrier();
+
+    uint32_t tail = edge_tail;
+    while (tail != head)
+    {
+        const button_edge_t *edge = &edge_buffer[tail & (EDGE_BUFFER_SIZE - 1)];
+        uint32_t bit = 1u << edge->pin;
+
+        if (edge->pressed != ((button_state & bit) != 0))
+        {
+            if (!edge_pending)
+            {
+                edge_pending = true;
+                pending_edge_us = edge->time_us;
+            }
+            if (edge->pressed)
+                latched_press |= bit;
+            button_state ^= bit;
+        }
+        tail++;
+    }
+
+    __compiler_memory_barrier();
+    edge_tail = tail;
+
+    // Pins whose level disagrees with the accepted state: either the level
+    // changed back inside the lockout, or edges were dropped. Adopt the level
+    // once the pin has been quiet for the debounce time.
+    uint32_t level = ~gpio_get_all() & button_mask;
+    uint32_t mismatch = level ^ button_state;
+    uint32_t dropped = edge_dropped;
+    if (mismatch == 0 && dropped == seen_dropped)
+        return;
+    seen_dropped = dropped;
+
+    uint32_t now = time_us_32();
+    uint32_t irq_mask = save_and_disable_interrupts();
+    for (uint pin = 0; pin < 32; pin++)
+    {
+        uint32_t bit = 1u << pin;
+        if (!(mismatch & bit) || now - accepted_us[pin] < BUTTON_DEBOUNCE_US)
+            continue;
+
+        if (!edge_pending)
+        {
+            edge_pending = true;
+            pending_edge_us = now;
+        }
+        if (level & bit)
+            latched_press |= bit;
+        button_state ^= bit;
+        irq_state = (irq_state & ~bit) | (level & bit);
+        accepted_us[pin] = now;
+    }
+    restore_interrupts(irq_mask);
+}
+
+uint32_t HOT_PATH_FUNC(button_capture_pressed)(void)
+{
+    return button_state | latched_press;
+}
+
+bool HOT_PATH_FUNC(button_capture_pending)(void)
+{
+    return edge_pending;
+}
+
+void HOT_PATH_FUNC(button_capture_reported)(void)
+{
+    latched_press = 0;
+
+    if (edge_pending)
+    {
+        last_latency_us = time_us_32() - pending_edge_us;
+        if (last_latency_us > max_latency_us)
+            max_latency_us = last_latency_us;
+        edge_pending = false;
+    }
+}
+
+uint32_t button_capture_last_latency_us(void)
+{
+    return last_latency_us;
+}
+
+uint32_t button_capture_max_latency_us(void)
+{
+    return max_latency_us;
+}
+
+uint32_t button_capture_dropped(void)
+{
+    return edge_dropped;
+}
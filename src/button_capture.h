@@ -0,0 +1,57 @@
+#ifndef BUTTON_CAPTURE_H_
+#define BUTTON_CAPTURE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Edge-triggered button capture.
+// Every rising/falling edge on a button pin is stamped with time_us_32() from
+// the GPIO IRQ and queued in a single-producer/single-consumer ring buffer.
+// The main loop drains the queue once per iteration instead of sampling the
+// pins, so press timing is no longer quantised to loop jitter.
+//
+// Debounce: after an edge is accepted on a pin, further edges on that pin are
+// ignored for BUTTON_DEBOUNCE_US. The accepted edge's direction decides the
+// new state, so release bounce cannot turn into a second press. Once the
+// lockout expires the pin level is trusted again, so a glitch that ended
+// inside the window is corrected on the next update.
+
+// Microswitch bounce settles within a few ms. 4 ms still allows 125
+// press/release cycles per second on one key.
+#ifndef BUTTON_DEBOUNCE_US
+#define BUTTON_DEBOUNCE_US 4000
+#endif
+
+typedef struct
+{
+    uint32_t time_us; // time_us_32() at the edge, compare by difference only
+    uint8_t pin;
+    bool pressed;     // active low: falling edge = pressed
+} button_edge_t;
+
+// pin_mask: GPIO mask of all button pins. Pins must already be configured as inputs.
+void button_capture_init(uint32_t pin_mask);
+
+// Drain queued edges. Call once per main loop iteration.
+void button_capture_update(void);
+
+// Current pressed pins, plus any press seen since the last report was sent
+// (so taps shorter than the report interval are not lost).
+uint32_t button_capture_pressed(void);
+
+// True when an accepted edge has not been carried by a report yet, so the
+// caller can send without waiting for the report interval.
+bool button_capture_pending(void);
+
+// Call after a report has been queued to the host. Clears latched taps and
+// records edge-to-report latency for the first edge that report carried.
+void button_capture_reported(void);
+
+// Latency of the most recent / worst report, measured from the edge time.
+uint32_t button_capture_last_latency_us(void);
+uint32_t button_capture_max_latency_us(void);
+
+// Number of edges dropped because the ring buffer was full.
+uint32_t button_capture_dropped(void);
+
+#endif /* BUTTON_CAPTURE_H_ */
@@ -0,0 +1,156 @@
+#ifndef CONTROLLER_LAYOUT_H_
+#define CONTROLLER_LAYOUT_H_
+
+// Single description of the controller: button pins and key codes, the
+// turntable axis, and the shape of the gamepad report.
+// The GPIO init mask, report packing and keyboard mapping are derived from the
+// button table at compile time. The report shape below is set by hand; the
+// HID descriptor uses it and static_asserts check it against the table.
+
+//--------------------------------------------------------------------+
+// Report shape (shared with the C descriptors)
+//--------------------------------------------------------------------+
+
+// Button bits in the gamepad report, must be a multiple of 8
+#define CONTROLLER_REPORT_BUTTONS 16
+// 8-bit axes in the gamepad report (X: turntable, Y: unused)
+#define CONTROLLER_REPORT_AXES 2
+
+#ifdef __cplusplus
+
+#include <stddef.h>
+#include <stdint.h>
+#include <array>
+#include <utility>
+
+namespace controller
+{
+    // USB HID keycodes
+    constexpr uint8_t KEY_A = 0x04;
+    constexpr uint8_t KEY_S = 0x16;
+    constexpr uint8_t KEY_D = 0x07;
+    constexpr uint8_t KEY_F = 0x09;
+    constexpr uint8_t KEY_G = 0x0A;
+    constexpr uint8_t KEY_H = 0x0B;
+    constexpr uint8_t KEY_J = 0x0D;
+    constexpr uint8_t KEY_K = 0x0E;
+    constexpr uint8_t KEY_L = 0x0F;
+    constexpr uint8_t KEY_Z = 0x1D;
+    constexpr uint8_t KEY_X = 0x1B;
+
+    struct Button
+    {
+        uint8_t pin; // GPIO, active low with pull-up
+        uint8_t key; // keycode sent in keyboard mode
+    };
+
+    // Index in this table = bit in the gamepad report (button i -> HID button i + 1)
+    inline constexpr Button buttons[] = {
+        {0, KEY_A},
+        {1, KEY_S},
+        {2, KEY_D},
+        {3, KEY_F},
+        {4, KEY_G},
+        {5, KEY_H},
+        {6, KEY_J},
+        {7, KEY_K},
+        {8, KEY_L},
+        {9, KEY_Z},
+        {10, KEY_X},
+    };
+
+    constexpr size_t button_count = sizeof(buttons) / sizeof(buttons[0]);
+
+    // Turntable potentiometer
+    constexpr unsigned turntable_pin = 26;
+    constexpr unsigned turntable_adc_input = turntable_pin - 26;
+
+    constexpr uint32_t button_bit(size_t index)
+    {
+        return 1u << index;
+    }
+
+    constexpr std::array<uint8_t, button_count> make_key_table()
+    {
+        std::array<uint8_t, button_count> keys{};
+        for (size_t i = 0; i < button_count; i++)
+            keys[i] = buttons[i].key;
+        return keys;
+    }
+
+    constexpr uint32_t make_button_pin_mask()
+    {
+        uint32_t mask = 0;
+        for (size_t i = 0; i < button_count; i++)
+            mask |= 1u << buttons[i].pin;
+        return mask;
+    }
+
+    constexpr uint32_t button_pin_mask = make_button_pin_mask();
+
+    constexpr bool pins_unique()
+    {
+        for (size_t i = 0; i < button_count; i++)
+            for (size_t j = i + 1; j < button_count; j++)
+                if (buttons[i].pin == buttons[j].pin)
+                    return false;
+        return true;
+    }
+
+    // True when button i sits on pin (first pin + i), so packing is a shift and mask
+    constexpr bool pins_contiguous()
+    {
+        for (size_t i = 0; i < button_count; i++)
+            if (buttons[i].pin != buttons[0].pin + i)
+                return false;
+        return true;
+    }
+
+    constexpr bool keys_valid()
+    {
+        for (size_t i = 0; i < button_count; i++)
+            if (buttons[i].key == 0)
+                return false;
+        return true;
+    }
+
+    static_assert(button_count > 0, "controller needs at least one button");
+    static_assert(button_count <= CONTROLLER_REPORT_BUTTONS, "more buttons than the gamepad report carries");
+    static_assert(CONTROLLER_REPORT_BUTTONS % 8 == 0, "report buttons must fill whole bytes");
+    static_assert(pins_unique(), "two buttons share a GPIO");
+    static_assert((button_pin_mask & ~((1u << 30) - 1)) == 0, "button pin is not a valid RP2040 GPIO");
+    static_assert((button_pin_mask & (1u << turntable_pin)) == 0, "button pin collides with the turntable");
+    static_assert(turntable_pin >= 26 && turntable_pin <= 29, "turntable must be on an ADC capable GPIO");
+    static_assert(keys_valid(), "button without a keycode");
+
+    template <size_t... I>
+    constexpr uint32_t pack_buttons_permuted(uint32_t pins, std::index_sequence<I...>)
+    {
+        return ((((pins >> buttons[I].pin) & 1u) << I) | ... | 0u);
+    }
+
+    // Pressed GPIO mask -> button bits in table order. Branchless either way.
+    constexpr uint32_t pack_buttons(uint32_t pins)
+    {
+        if constexpr (pins_contiguous())
+            return (pins >> buttons[0].pin) & ((1u << button_count) - 1);
+        else
+            return pack_buttons_permuted(pins, std::make_index_sequence<button_count>{});
+    }
+
+    static_assert(pack_buttons(button_pin_mask) == (1u << button_count) - 1, "packing drops buttons");
+
+    constexpr bool packing_maps_each_button()
+    {
+        for (size_t i = 0; i < button_count; i++)
+            if (pack_buttons(1u << buttons[i].pin) != button_bit(i))
+                return false;
+        return true;
+    }
+
+    static_assert(packing_maps_each_button(), "packing misplaces buttons");
+}
+
+#endif
+
+#endif /* CONTROLLER_LAYOUT_H_ */
@@ -0,0 +1,20 @@
+#ifndef HOT_PATH_H_
+#define HOT_PATH_H_
+
+#include "pico/platform.h"
+
+// Placement of the input hot path: turntable sampling and filters, button
+// packing, and the edge capture IRQ. With ENABLE_HOT_PATH_IN_RAM the marked
+// functions and tables are copied to SRAM at boot, so XIP cache misses cannot
+// stall them. They must only call inline SDK helpers or other marked code.
+// main(), USB (TinyUSB, hid_task) and debug output stay in flash.
+
+#ifdef ENABLE_HOT_PATH_IN_RAM
+#define HOT_PATH_FUNC(name) __not_in_flash_func(name)
+#define HOT_PATH_DATA(name) __not_in_flash(#name)
+#else
+#define HOT_PATH_FUNC(name) name
+#define HOT_PATH_DATA(name)
+#endif
+
+#endif /* HOT_PATH_H_ */
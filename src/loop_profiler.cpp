@@ -0,0 +1,117 @@
+#include "loop_profiler.h"
+
+#ifdef ENABLE_LOOP_PROFILER
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hardware/timer.h"
+
+#include "hot_path.h"
+
+typedef struct
+{
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t total_us;
+} stage_stats_t;
+
+static const char *const stage_names[PROFILE_STAGE_COUNT] = {
+    "tud_task",
+    "hid_task",
+    "adc_read",
+    "filter",
+    "changeRange",
+    "speed",
+    "debug_out",
+    "buttons",
+};
+
+static stage_stats_t stage_stats[PROFILE_STAGE_COUNT];
+static stage_stats_t loop_stats;
+static uint32_t iteration_count = 0;
+
+static uint32_t iteration_start = 0;
+static uint32_t last_mark = 0;
+static uint32_t current_us[PROFILE_STAGE_COUNT];
+
+// Stage breakdown of the slowest iteration so far
+static uint32_t worst_us[PROFILE_STAGE_COUNT];
+
+static void HOT_PATH_FUNC(stats_add)(stage_stats_t *stats, uint32_t elapsed)
+{
+    if (iteration_count == 0 || elapsed < stats->min_us)
+        stats->min_us = elapsed;
+    if (elapsed > stats->max_us)
+        stats->max_us = elapsed;
+    stats->total_us += elapsed;
+}
+
+void loop_profiler_reset(void)
+{
+    memset(stage_stats, 0, sizeof(stage_stats));
+    memset(&loop_stats, 0, sizeof(loop_stats));
+    memset(worst_us, 0, sizeof(worst_us));
+    iteration_count = 0;
+}
+
+void HOT_PATH_FUNC(loop_profiler_begin_iteration)(void)
+{
+    memset(current_us, 0, sizeof(current_us));
+    iteration_start = time_us_32();
+    last_mark = iteration_start;
+}
+
+void HOT_PATH_FUNC(loop_profiler_mark)(int stage)
+{
+    uint32_t now = time_us_32();
+    current_us[stage] += now - last_mark;
+    last_mark = now;
+}
+
+void HOT_PATH_FUNC(loop_profiler_end_iteration)(void)
+{
+    uint32_t elapsed = last_mark - iteration_start;
+
+    for (int i = 0; i < PROFILE_STAGE_COUNT; i++)
+        stats_add(&stage_stats[i], current_us[i]);
+
+    if (elapsed > loop_stats.max_us)
+        memcpy(worst_us, current_us, sizeof(worst_us));
+    stats_add(&loop_stats, elapsed);
+
+    iteration_count++;
+}
+
+void loop_profiler_dump(void (*write)(const char *))
+{
+    char line[96];
+
+    if (iteration_count == 0)
+    {
+        write("profile: no samples\r\n");
+        return;
+    }
+
+    snprintf(line, sizeof(line), "profile: %lu iterations (us: min avg max worst)\r\n", (unsigned long)iteration_count);
+    write(line);
+
+    for (int i = 0; i < PROFILE_STAGE_COUNT; i++)
+    {
+        const stage_stats_t *stats = &stage_stats[i];
+        snprintf(line, sizeof(line), "  %-12s %5lu %5lu %5lu %5lu\r\n", stage_names[i],
+                 (unsigned long)stats->min_us,
+                 (unsigned long)(stats->total_us / iteration_count),
+                 (unsigned long)stats->max_us,
+                 (unsigned long)worst_us[i]);
+        write(line);
+    }
+
+    snprintf(line, sizeof(line), "  %-12s %5lu %5lu %5lu\r\n", "loop",
+             (unsigned long)loop_stats.min_us,
+             (unsigned long)(loop_stats.total_us / iteration_count),
+             (unsigned long)loop_stats.max_us);
+    write(line);
+}
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef LOOP_PROFILER_H_
+#define LOOP_PROFILER_H_
+
+#include <stdint.h>
+
+// Per-stage main loop profiler.
+// Each stage is timed with the 1 MHz hardware timer (time_us_32()) as the lap
+// since the previous mark, so a sequential loop costs one timer read per stage.
+// Built only when ENABLE_LOOP_PROFILER is defined; otherwise every macro
+// below expands to nothing.
+
+enum
+{
+    PROFILE_STAGE_TUD_TASK = 0,
+    PROFILE_STAGE_HID_TASK,
+    PROFILE_STAGE_ADC_READ,
+    PROFILE_STAGE_FILTER,
+    PROFILE_STAGE_CHANGE_RANGE,
+    PROFILE_STAGE_SPEED,
+    PROFILE_STAGE_DEBUG_OUTPUT,
+    PROFILE_STAGE_BUTTONS,
+    PROFILE_STAGE_COUNT
+};
+
+#ifdef ENABLE_LOOP_PROFILER
+
+void loop_profiler_begin_iteration(void);
+void loop_profiler_mark(int stage);
+void loop_profiler_end_iteration(void);
+void loop_profiler_reset(void);
+
+// Writes one line per stage (min/avg/max and the stage's share of the
+// slowest iteration seen) plus a total line.
+void loop_profiler_dump(void (*write)(const char *));
+
+#define PROFILE_LOOP_BEGIN() loop_profiler_begin_iteration()
+#define PROFILE_MARK(stage) loop_profiler_mark(stage)
+#define PROFILE_LOOP_END() loop_profiler_end_iteration()
+
+#else
+
+#define PROFILE_LOOP_BEGIN()
+#define PROFILE_MARK(stage)
+#define PROFILE_LOOP_END()
+
+#endif
+
+#endif /* LOOP_PROFILER_H_ */
@@ -16,6 +16,12 @@
 #include "tusb.h"
 #include "tusb_config.h"
 #include "./usb_descriptors.h"
+#include "./controller_layout.h"
+#ifdef ENABLE_EDGE_CAPTURE
+#include "./button_capture.h"
+#endif
+#include "./loop_profiler.h"
+#include "./hot_path.h"
 
 #include "bsp/board_api.h"
 #include "class/hid/hid.h"
@@ -25,45 +31,32 @@ void hid_task(void);
 hid_iidxpad_report_t gamepad_report = {0};
 hid_keyboard_report_t keyboard_report = {0};
 
-// Key mapping for IIDX buttons (USB HID keycodes)
-#define KEY_A 0x04
-#define KEY_S 0x16
-#define KEY_D 0x07
-#define KEY_F 0x09
-#define KEY_G 0x0A
-#define KEY_H 0x0B
-#define KEY_J 0x0D
-#define KEY_K 0x0E
-#define KEY_L 0x0F
-#define KEY_Z 0x1D
-#define KEY_X 0x1B
-
-// Key mapping array for buttons 0-10
-// Button 0 -> A, Button 1 -> S, Button 2 -> D, Button 3 -> F, Button 4 -> G,
-// Button 5 -> H, Button 6 -> J, Button 7 -> K, Button 8 -> L, Button 9 -> Z, Button 10 -> X
-const uint8_t button_keys[11] = {
-    KEY_A, KEY_S, KEY_D, KEY_F, KEY_G, KEY_H, KEY_J, KEY_K, KEY_L, KEY_Z, KEY_X};
-
-#define BUTTON0_PIN 0
-#define BUTTON1_PIN 1
-#define BUTTON2_PIN 2
-#define BUTTON3_PIN 3
-#define BUTTON4_PIN 4
-#define BUTTON5_PIN 5
-#define BUTTON6_PIN 6
-#define BUTTON7_PIN 7
-#define BUTTON8_PIN 8
-#define BUTTON9_PIN 9
-#define BUTTON10_PIN 10
-
-#define setup_input_pin(pin)    \
-    gpio_init(pin);             \
-    gpio_set_dir(pin, GPIO_IN); \
-    gpio_pull_up(pin);
+// Mode switch combos (button indices from controller_layout.h)
+constexpr uint32_t MODE_COMBO_BASE = controller::button_bit(7) | controller::button_bit(10);
+constexpr uint32_t MODE_COMBO_GAMEPAD = MODE_COMBO_BASE | controller::button_bit(1);
+constexpr uint32_t MODE_COMBO_KEYBOARD = MODE_COMBO_BASE | controller::button_bit(3);
+constexpr uint32_t MODE_COMBO_CALIBRATE = MODE_COMBO_BASE | controller::button_bit(5);
+static_assert(controller::button_count > 10, "mode combos need buttons 1, 3, 5, 7 and 10");
 
 bool mode = false; // false: gamepad mode, true: keyboard mode
 
-int changeRange(int reqMin, int reqMax, int inMin, int inMax, int value)
+#define TURNTABLE_CENTER 0x80
+
+// Boot timing. time_us_64() counts from when the SDK runtime starts the timer,
+// so bootrom/boot2 and the RAM copy before it are not included.
+bool report_on_mount = false; // send the first report without waiting for the interval
+uint64_t mount_us = 0;
+uint64_t first_report_us = 0; // when the first report was queued, not when the host read it
+
+void init_button_pins(void)
+{
+    gpio_init_mask(controller::button_pin_mask);
+    gpio_set_dir_in_masked(controller::button_pin_mask);
+    for (size_t i = 0; i < controller::button_count; i++)
+        gpio_pull_up(controller::buttons[i].pin);
+}
+
+int HOT_PATH_FUNC(changeRange)(int reqMin, int reqMax, int inMin, int inMax, int value)
 {
     if (value < inMin)
         value = inMin;
@@ -75,17 +68,20 @@ int changeRange(int reqMin, int reqMax, int inMin, int inMax, int value)
     return (int)(result + 0.5);
 }
 
+// Keycode per button index, in RAM next to the code that reads it
+static const std::array<uint8_t, controller::button_count> button_keys HOT_PATH_DATA(button_keys) = controller::make_key_table();
+
 // 6-Key Rollover implementation
-void update_keyboard_report(bool button_states[11])
+void HOT_PATH_FUNC(update_keyboard_report)(uint32_t buttons)
 {
     // Clear all keys first
     memset(keyboard_report.keycode, 0, sizeof(keyboard_report.keycode));
 
     // Add pressed keys to the report (up to 6 keys)
     uint8_t key_count = 0;
-    for (int i = 0; i < 11 && key_count < 6; i++)
+    for (size_t i = 0; i < controller::button_count && key_count < 6; i++)
     {
-        if (button_states[i])
+        if (buttons & controller::button_bit(i))
         {
             keyboard_report.keycode[key_count] = button_keys[i];
             key_count++;
@@ -93,15 +89,16 @@ void update_keyboard_report(bool button_states[11])
     }
 }
 
-void send_keyboard_report(void)
+bool send_keyboard_report(void)
 {
     if (tud_hid_n_ready(ITF_NUM_KEYBOARD))
     {
         // Always send the current keyboard report state
         // In keyboard mode, it contains the pressed keys
         // In gamepad mode, it should be empty (keys cleared in main loop)
-        tud_hid_n_report(ITF_NUM_KEYBOARD, 0, &keyboard_report, sizeof(keyboard_report));
+        return tud_hid_n_report(ITF_NUM_KEYBOARD, 0, &keyboard_report, sizeof(keyboard_report));
     }
+    return false;
 }
 
 bool mode_key_pressed = false;
@@ -122,137 +119,253 @@ void write_response(const char *response)
 #endif
 }
 
-int main()
-{
-    board_init();
-    tusb_init();
-    adc_init();
-
-    adc_gpio_init(26);   // Initialize GPIO 26 for ADC
-    adc_select_input(0); // Select ADC input 0 (GPIO 26)
-
-    // Initialize button pins
-    setup_input_pin(BUTTON0_PIN);
-    setup_input_pin(BUTTON1_PIN);
-    setup_input_pin(BUTTON2_PIN);
-    setup_input_pin(BUTTON3_PIN);
-    setup_input_pin(BUTTON4_PIN);
-    setup_input_pin(BUTTON5_PIN);
-    setup_input_pin(BUTTON6_PIN);
-    setup_input_pin(BUTTON7_PIN);
-    setup_input_pin(BUTTON8_PIN);
-    setup_input_pin(BUTTON9_PIN);
-    setup_input_pin(BUTTON10_PIN);
-
-    int setted_min = -1;
-    int setted_max = -1;
-    int res_min = 0;
-    int res_max = 255;
-
-    double min_speed = 360.0 / 7.0 / 1000.0; // degrees per millisecond (= 100 degrees per second)
-
-    const int sample_count = 20;
-    int last_values[sample_count] = {
-        0,
-    };
-    uint32_t time_values[sample_count] = {
-        0,
-    };
-
-    // Noise filtering variables
-    const int noise_threshold = 4; // Minimum change to consider as real movement
-    int last_stable_read = 0;
-    bool first_read = true;
+// Turntable sampling
+#define TURNTABLE_SAMPLE_COUNT 20
+#define TURNTABLE_FILTER_SIZE 8
+#define TURNTABLE_NOISE_THRESHOLD 4 // Minimum change to consider as real movement
+#define TURNTABLE_RES_MIN 0
+#define TURNTABLE_RES_MAX 255
+
+// After power-up the turntable stays centred until the calibrated span can
+// resolve the output: one deadband step (TURNTABLE_NOISE_THRESHOLD counts) per
+// output step. Before that the range is still growing and the output jumps.
+// Sensors with less travel than that are released once the turntable has
+// been turned continuously for CALIBRATION_BOOT_TIMEOUT_US. Motion here is raw
+// ADC travel (a deadband step at least every CALIBRATION_MOTION_GAP_US), not
+// the speed, which is meaningless while the range is still a few counts wide.
+// A noise step or a bump only starts the timer; it resets when steps stop.
+// The recalibrate combo does not re-arm this gate.
+#ifndef CALIBRATION_MIN_SPAN
+#define CALIBRATION_MIN_SPAN ((TURNTABLE_RES_MAX - TURNTABLE_RES_MIN) * TURNTABLE_NOISE_THRESHOLD)
+#endif
+#define CALIBRATION_BOOT_TIMEOUT_US 2000000
+#define CALIBRATION_MOTION_GAP_US 50000
 
-    // Moving average filter
-    const int filter_size = 8;
-    int adc_readings[filter_size] = {0};
-    int filter_index = 0;
-    int filter_sum = 0;
+const double min_speed = 360.0 / 7.0 / 1000.0; // degrees per millisecond (= 100 degrees per second)
 
-    while (1)
-    {
-        tud_task();
-        hid_task();
+typedef struct
+{
+    int setted_min;
+    int setted_max;
 
-        // Read ADC with filtering
-        int raw_read = adc_read();
+    int last_values[TURNTABLE_SAMPLE_COUNT];
+    uint32_t time_values[TURNTABLE_SAMPLE_COUNT]; // time_us_32() of each sample
 
-        // Apply moving average filter
-        filter_sum -= adc_readings[filter_index];
-        adc_readings[filter_index] = raw_read;
-        filter_sum += raw_read;
-        filter_index = (filter_index + 1) % filter_size;
-        int filtered_read = filter_sum / filter_size;
+    // Noise filtering
+    int last_stable_read;
+    bool first_read;
 
-        // Apply deadband filter to reduce noise
-        int read;
-        if (first_read)
+    // Moving average filter
+    int adc_readings[TURNTABLE_FILTER_SIZE];
+    int filter_index;
+    int filter_sum;
+
+    // Power-up calibration gate
+    bool boot_gate;
+    bool boot_motion_seen;   // turning continuously since boot_motion_us
+    uint32_t boot_motion_us; // start of the current continuous motion
+    uint32_t boot_step_us;   // last deadband step
+
+    // Results of the last sample, for calibration and debug output
+    int read;
+    int mapped_value;
+    int degree_value;
+    int speed;
+    double deg_per_ms;
+} turntable_t;
+
+// Read the ADC, filter, map and update gamepad_report.x
+void HOT_PATH_FUNC(sample_turntable)(turntable_t *tt)
+{
+    // Read ADC with filtering
+    int raw_read = adc_read();
+    PROFILE_MARK(PROFILE_STAGE_ADC_READ);
+
+    // Apply moving average filter
+    tt->filter_sum -= tt->adc_readings[tt->filter_index];
+    tt->adc_readings[tt->filter_index] = raw_read;
+    tt->filter_sum += raw_read;
+    tt->filter_index = (tt->filter_index + 1) % TURNTABLE_FILTER_SIZE;
+    int filtered_read = tt->filter_sum / TURNTABLE_FILTER_SIZE;
+
+    // Apply deadband filter to reduce noise
+    int read;
+    if (tt->first_read)
+    {
+        read = filtered_read;
+        tt->last_stable_read = filtered_read;
+        tt->first_read = false;
+    }
+    else
+    {
+        if (abs(filtered_read - tt->last_stable_read) >= TURNTABLE_NOISE_THRESHOLD)
         {
             read = filtered_read;
-            last_stable_read = filtered_read;
-            first_read = false;
+            tt->last_stable_read = filtered_read;
         }
         else
         {
-            if (abs(filtered_read - last_stable_read) >= noise_threshold)
-            {
-                read = filtered_read;
-                last_stable_read = filtered_read;
-            }
-            else
-            {
-                read = last_stable_read; // Use last stable value if change is too small
-            }
+            read = tt->last_stable_read; // Use last stable value if change is too small
         }
+    }
 
-        if (setted_min == -1 || setted_max == -1)
-        {
-            setted_min = read;
-            setted_max = read;
-        }
+    PROFILE_MARK(PROFILE_STAGE_FILTER);
+
+    if (tt->setted_min == -1 || tt->setted_max == -1)
+    {
+        tt->setted_min = read;
+        tt->setted_max = read;
+    }
 
-        if (read < setted_min)
-            setted_min = read;
-        if (read > setted_max)
-            setted_max = read;
-        int mapped_value = changeRange(res_min, res_max, setted_min, setted_max, read);
-        int degree_value = changeRange(0, 360, setted_min, setted_max, read);
+    if (read < tt->setted_min)
+        tt->setted_min = read;
+    if (read > tt->setted_max)
+        tt->setted_max = read;
+    int mapped_value = changeRange(TURNTABLE_RES_MIN, TURNTABLE_RES_MAX, tt->setted_min, tt->setted_max, read);
+    int degree_value = changeRange(0, 360, tt->setted_min, tt->setted_max, read);
+    PROFILE_MARK(PROFILE_STAGE_CHANGE_RANGE);
 
-        int speed = 0;
-        for (int i = sample_count - 1; i > 0; i--)
+    int speed = 0;
+    for (int i = TURNTABLE_SAMPLE_COUNT - 1; i > 0; i--)
+    {
+        tt->last_values[i] = tt->last_values[i - 1];
+        tt->time_values[i] = tt->time_values[i - 1];
+    }
+    tt->last_values[0] = degree_value;
+    tt->time_values[0] = time_us_32();
+    for (int i = 0; i < TURNTABLE_SAMPLE_COUNT - 1; i++)
+    {
+        int diff = (tt->last_values[i] - tt->last_values[i + 1]);
+        // Handle wrap-around
+        if (diff > 180)
         {
-            last_values[i] = last_values[i - 1];
-            time_values[i] = time_values[i - 1];
+            diff = 360 - diff;
         }
-        last_values[0] = degree_value;
-        time_values[0] = board_millis();
-        for (int i = 0; i < sample_count - 1; i++)
+        else if (diff < -180)
         {
-            int diff = (last_values[i] - last_values[i + 1]);
-            // Handle wrap-around
-            if (diff > 180)
-            {
-                diff = 360 - diff;
-            }
-            else if (diff < -180)
+            diff = -360 - diff;
+        }
+        speed += diff;
+    }
+
+    uint32_t delta_us = tt->time_values[0] - tt->time_values[TURNTABLE_SAMPLE_COUNT - 1];
+
+    double deg_per_ms = (double)speed * 1000.0 / (double)delta_us;
+
+    bool moving = abs(deg_per_ms) >= min_speed;
+    if (tt->boot_gate)
+    {
+        uint32_t now = tt->time_values[0];
+        if (read != tt->read) // moved by at least one deadband step
+        {
+            if (!tt->boot_motion_seen)
             {
-                diff = -360 - diff;
+                tt->boot_motion_seen = true;
+                tt->boot_motion_us = now;
             }
-            speed += diff;
+            tt->boot_step_us = now;
+        }
+        else if (tt->boot_motion_seen && now - tt->boot_step_us >= CALIBRATION_MOTION_GAP_US)
+        {
+            tt->boot_motion_seen = false; // stopped turning, start over
         }
 
-        uint32_t current_time = board_millis();
-        uint32_t delta_time = current_time - time_values[sample_count - 1];
+        if (tt->setted_max - tt->setted_min >= CALIBRATION_MIN_SPAN ||
+            (tt->boot_motion_seen && now - tt->boot_motion_us >= CALIBRATION_BOOT_TIMEOUT_US))
+            tt->boot_gate = false;
+    }
 
-        double deg_per_ms = (double)speed / (double)delta_time;
+    if (!tt->boot_gate && moving)
+    {
+        gamepad_report.x = (uint8_t)mapped_value;
+    }
+    // gamepad_report.x = read & 0xFF;
+    // gamepad_report.y = (read >> 8) & 0xFF;
+
+    tt->read = read;
+    tt->mapped_value = mapped_value;
+    tt->degree_value = degree_value;
+    tt->speed = speed;
+    tt->deg_per_ms = deg_per_ms;
+    PROFILE_MARK(PROFILE_STAGE_SPEED);
+}
 
-        if (abs(deg_per_ms) >= min_speed)
+// Read the buttons and pack them into the gamepad and keyboard reports.
+// Returns the pressed buttons, bit i = controller::buttons[i].
+uint32_t HOT_PATH_FUNC(read_buttons)(void)
+{
+#ifdef ENABLE_EDGE_CAPTURE
+    button_capture_update();
+    uint32_t pressed_pins = button_capture_pressed();
+#else
+    uint32_t pressed_pins = ~gpio_get_all() & controller::button_pin_mask;
+#endif
+    uint32_t buttons = controller::pack_buttons(pressed_pins);
+
+    for (size_t i = 0; i < sizeof(gamepad_report.buttons); i++)
+    {
+        gamepad_report.buttons[i] = (uint8_t)(buttons >> (8 * i));
+    }
+
+    // Update keyboard report based on current mode
+    if (mode) // keyboard mode
+    {
+        update_keyboard_report(buttons);
+    }
+    else // gamepad mode - clear keyboard
+    {
+        memset(keyboard_report.keycode, 0, sizeof(keyboard_report.keycode));
+    }
+
+    return buttons;
+}
+
+int main()
+{
+    // Buttons first, so the very first report already carries their state
+    init_button_pins();
+
+    // Start USB right away: enumeration is the slow part of boot and runs
+    // while the rest of the setup happens
+    tusb_init();
+
+    adc_init();
+    adc_gpio_init(controller::turntable_pin);
+    adc_select_input(controller::turntable_adc_input);
+
+#ifdef ENABLE_EDGE_CAPTURE
+    button_capture_init(controller::button_pin_mask);
+#endif
+
+    gamepad_report.x = TURNTABLE_CENTER;
+
+    // board_init() only sets up the board LED/UART, wait until we are configured
+    bool board_ready = false;
+
+    static turntable_t turntable = {0};
+    turntable.setted_min = -1;
+    turntable.setted_max = -1;
+    turntable.first_read = true;
+    turntable.boot_gate = true;
+
+    while (1)
+    {
+        PROFILE_LOOP_BEGIN();
+
+        tud_task();
+        PROFILE_MARK(PROFILE_STAGE_TUD_TASK);
+
+        if (!board_ready && first_report_us != 0)
         {
-            gamepad_report.x = (uint8_t)mapped_value;
+            board_init();
+            // The board LED/UART/button may share pins with buttons, take them back
+            init_button_pins();
+            board_ready = true;
         }
-        // gamepad_report.x = read & 0xFF;
-        // gamepad_report.y = (read >> 8) & 0xFF;
+        hid_task();
+        PROFILE_MARK(PROFILE_STAGE_HID_TASK);
+
+        sample_turntable(&turntable);
 
         static int report_counter = 0;
         report_counter++;
@@ -260,53 +373,40 @@ int main()
         {
             report_counter = 0;
 
-            char response[128];
-            snprintf(response, sizeof(response), "D(\t%d,\t%d')\t m(\t%d,\t%d)\t M(%c%2d,\t%c%.3f)\r\n", mapped_value, degree_value, setted_min, setted_max, speed < 0 ? '-' : '+', abs(speed), deg_per_ms < 0 ? '-' : '+', abs(deg_per_ms));
+            const turntable_t *tt = &turntable;
+            char response[192];
+#ifdef ENABLE_EDGE_CAPTURE
+            snprintf(response, sizeof(response), "D(\t%d,\t%d')\t m(\t%d,\t%d)\t M(%c%2d,\t%c%.3f)\t L(%luus,\t%luus,\t%lu)\r\n", tt->mapped_value, tt->degree_value, tt->setted_min, tt->setted_max, tt->speed < 0 ? '-' : '+', abs(tt->speed), tt->deg_per_ms < 0 ? '-' : '+', abs(tt->deg_per_ms),
+                     (unsigned long)button_capture_last_latency_us(), (unsigned long)button_capture_max_latency_us(), (unsigned long)button_capture_dropped());
+#else
+            snprintf(response, sizeof(response), "D(\t%d,\t%d')\t m(\t%d,\t%d)\t M(%c%2d,\t%c%.3f)\r\n", tt->mapped_value, tt->degree_value, tt->setted_min, tt->setted_max, tt->speed < 0 ? '-' : '+', abs(tt->speed), tt->deg_per_ms < 0 ? '-' : '+', abs(tt->deg_per_ms));
+#endif
             write_response(response);
-        }
 
-        // read buttons
-        bool gpioRead[] = {
-            gpio_get(BUTTON0_PIN) == 0,
-            gpio_get(BUTTON1_PIN) == 0,
-            gpio_get(BUTTON2_PIN) == 0,
-            gpio_get(BUTTON3_PIN) == 0,
-            gpio_get(BUTTON4_PIN) == 0,
-            gpio_get(BUTTON5_PIN) == 0,
-            gpio_get(BUTTON6_PIN) == 0,
-            gpio_get(BUTTON7_PIN) == 0,
-            gpio_get(BUTTON8_PIN) == 0,
-            gpio_get(BUTTON9_PIN) == 0,
-            gpio_get(BUTTON10_PIN) == 0};
-
-        gamepad_report.buttons[0] = 0;
-        gamepad_report.buttons[1] = 0;
-        gamepad_report.buttons[0] |= (gpioRead[0]) ? (1 << 0) : 0;
-        gamepad_report.buttons[0] |= (gpioRead[1]) ? (1 << 1) : 0;
-        gamepad_report.buttons[0] |= (gpioRead[2]) ? (1 << 2) : 0;
-        gamepad_report.buttons[0] |= (gpioRead[3]) ? (1 << 3) : 0;
-        gamepad_report.buttons[0] |= (gpioRead[4]) ? (1 << 4) : 0;
-        gamepad_report.buttons[0] |= (gpioRead[5]) ? (1 << 5) : 0;
-        gamepad_report.buttons[0] |= (gpioRead[6]) ? (1 << 6) : 0;
-        gamepad_report.buttons[0] |= (gpioRead[7]) ? (1 << 7) : 0;
-        gamepad_report.buttons[1] |= (gpioRead[8]) ? (1 << 0) : 0;
-        gamepad_report.buttons[1] |= (gpioRead[9]) ? (1 << 1) : 0;
-        gamepad_report.buttons[1] |= (gpioRead[10]) ? (1 << 2) : 0;
-
-        // Update keyboard report based on current mode
-        if (mode) // keyboard mode
-        {
-            update_keyboard_report(gpioRead);
-        }
-        else // gamepad mode - clear keyboard
-        {
-            memset(keyboard_report.keycode, 0, sizeof(keyboard_report.keycode));
+#ifdef ENABLE_CDC
+            static bool boot_time_reported = false;
+            if (!boot_time_reported && first_report_us != 0 && tud_cdc_connected())
+            {
+                snprintf(response, sizeof(response), "boot: mounted %lu us, first report %lu us\r\n", (unsigned long)mount_us, (unsigned long)first_report_us);
+                write_response(response);
+                boot_time_reported = true;
+            }
+#endif
         }
+        PROFILE_MARK(PROFILE_STAGE_DEBUG_OUTPUT);
+
+        uint32_t buttons = read_buttons();
+
+#ifdef ENABLE_EDGE_CAPTURE
+        // Queue the report carrying a new edge now rather than next iteration
+        if (button_capture_pending())
+            hid_task();
+#endif
 
         // BUTTON0, BUTTON3, BUTTON5 to switch mode
-        bool current_mode_key = gpioRead[7] && gpioRead[10] && gpioRead[1];  // gamepad mode
-        bool current_mode_key2 = gpioRead[7] && gpioRead[10] && gpioRead[3]; // keyboard mode
-        bool current_mode_key3 = gpioRead[7] && gpioRead[10] && gpioRead[5]; // calibrate mode
+        bool current_mode_key = (buttons & MODE_COMBO_GAMEPAD) == MODE_COMBO_GAMEPAD;     // gamepad mode
+        bool current_mode_key2 = (buttons & MODE_COMBO_KEYBOARD) == MODE_COMBO_KEYBOARD;  // keyboard mode
+        bool current_mode_key3 = (buttons & MODE_COMBO_CALIBRATE) == MODE_COMBO_CALIBRATE; // calibrate mode
         if ((current_mode_key || current_mode_key2 || current_mode_key3) && !mode_key_pressed)
         {
             if (current_mode_key || current_mode_key2)
@@ -315,10 +415,12 @@ int main()
             }
             else
             {
-                setted_max = read;
-                setted_min = read;
-                memset(last_values, 0, sizeof(last_values));
-                memset(time_values, board_millis(), sizeof(time_values));
+                turntable.setted_max = turntable.read;
+                turntable.setted_min = turntable.read;
+                memset(turntable.last_values, 0, sizeof(turntable.last_values));
+                uint32_t now = time_us_32();
+                for (int i = 0; i < TURNTABLE_SAMPLE_COUNT; i++)
+                    turntable.time_values[i] = now;
             }
 
             mode_key_pressed = true;
@@ -327,6 +429,21 @@ int main()
         {
             mode_key_pressed = false;
         }
+        PROFILE_MARK(PROFILE_STAGE_BUTTONS);
+
+        PROFILE_LOOP_END();
+
+#if defined(ENABLE_LOOP_PROFILER) && defined(ENABLE_CDC)
+        // 'p': dump loop profile, 'r': reset it
+        if (tud_cdc_available())
+        {
+            int command = tud_cdc_read_char();
+            if (command == 'p')
+                loop_profiler_dump(write_response);
+            else if (command == 'r')
+                loop_profiler_reset();
+        }
+#endif
 
         sleep_ms(1);
     }
@@ -338,6 +455,9 @@ int main()
 
 void tud_mount_cb(void)
 {
+    if (mount_us == 0)
+        mount_us = time_us_64();
+    report_on_mount = true;
 }
 
 void tud_umount_cb(void)
@@ -357,37 +477,60 @@ void tud_resume_cb(void)
 // HID Task
 // ========================
 
-void send_gamepad_report(void)
+bool send_gamepad_report(void)
 {
     // skip if hid is not ready
     if (tud_hid_n_ready(ITF_NUM_GAMEPAD))
     {
         if (!mode)
         {
-            tud_hid_n_report(ITF_NUM_GAMEPAD, 0, &gamepad_report, sizeof(gamepad_report));
+            return tud_hid_n_report(ITF_NUM_GAMEPAD, 0, &gamepad_report, sizeof(gamepad_report));
         }
         else
         {
             // In keyboard mode, send empty gamepad report
             hid_iidxpad_report_t empty_report = {0};
-            tud_hid_n_report(ITF_NUM_GAMEPAD, 0, &empty_report, sizeof(empty_report));
+            return tud_hid_n_report(ITF_NUM_GAMEPAD, 0, &empty_report, sizeof(empty_report));
         }
     }
+    return false;
 }
 
 void hid_task(void)
 {
     // Poll every 10ms
-    const uint32_t interval_ms = 10;
-    static uint32_t start_ms = 0;
+    const uint32_t interval_us = 10000;
+    static uint32_t start_us = 0;
 
-    uint32_t now = board_millis();
-    if (now - start_ms < interval_ms)
+    bool send_now = report_on_mount;
+#ifdef ENABLE_EDGE_CAPTURE
+    // A new edge goes out right away instead of on the next interval tick
+    send_now = send_now || button_capture_pending();
+#endif
+
+    uint32_t now = time_us_32();
+    if (!send_now && now - start_us < interval_us)
         return;
-    start_ms = now;
+    start_us = now;
+
+    bool gamepad_sent = send_gamepad_report();
+    bool keyboard_sent = send_keyboard_report();
+
+    if (gamepad_sent || keyboard_sent)
+    {
+        report_on_mount = false;
+        if (first_report_us == 0)
+            first_report_us = time_us_64();
+    }
 
-    send_gamepad_report();
-    send_keyboard_report();
+#ifdef ENABLE_EDGE_CAPTURE
+    // Buttons travel in the gamepad report in gamepad mode, the keyboard report otherwise
+    if (mode ? keyboard_sent : gamepad_sent)
+        button_capture_reported();
+#else
+    (void)gamepad_sent;
+    (void)keyboard_sent;
+#endif
 }
 
 void tud_hid_report_complete_cb(uint8_t instance, uint8_t const *report, uint16_t len)
@@ -73,8 +73,7 @@ extern "C"
 #define CFG_TUD_ENDPOINT0_SIZE 64
 #endif
 
-#define ENABLE_CDC
-#undef ENABLE_CDC
+// ENABLE_CDC (debug serial port) is set by the IIDX_CDC CMake option
 
 //------------- CLASS -------------//
 #define CFG_TUD_HID 2
@@ -30,14 +30,14 @@ uint8_t const desc_hid_report_gamepad[] = {
     HID_USAGE_PAGE(HID_USAGE_PAGE_DESKTOP),
     HID_USAGE(HID_USAGE_DESKTOP_GAMEPAD),
     HID_COLLECTION(HID_COLLECTION_APPLICATION),
-    // 16 buttons
+    // Buttons
     HID_USAGE_PAGE(HID_USAGE_PAGE_BUTTON),
     HID_USAGE_MIN(1),
-    HID_USAGE_MAX(16),
+    HID_USAGE_MAX(CONTROLLER_REPORT_BUTTONS),
     HID_LOGICAL_MIN(0),
     HID_LOGICAL_MAX(1),
     HID_REPORT_SIZE(1),
-    HID_REPORT_COUNT(16),
+    HID_REPORT_COUNT(CONTROLLER_REPORT_BUTTONS),
     HID_INPUT(HID_DATA | HID_VARIABLE | HID_ABSOLUTE),
 
     // X and Y axes (0-255)
@@ -47,7 +47,7 @@ uint8_t const desc_hid_report_gamepad[] = {
     HID_LOGICAL_MIN(0),
     HID_LOGICAL_MAX_N(255, 2),
     HID_REPORT_SIZE(8),
-    HID_REPORT_COUNT(2),
+    HID_REPORT_COUNT(CONTROLLER_REPORT_AXES),
     HID_INPUT(HID_DATA | HID_VARIABLE | HID_ABSOLUTE),
     HID_COLLECTION_END};
 
@@ -2,6 +2,7 @@
 #define USB_DESCRIPTORS_H_
 
 #include "tusb.h"
+#include "controller_layout.h"
 
 enum
 {
@@ -15,11 +16,14 @@ enum
 
 typedef struct TU_ATTR_PACKED
 {
-  uint8_t buttons[2]; // 16 buttons
+  uint8_t buttons[CONTROLLER_REPORT_BUTTONS / 8];
   uint8_t x;          // X axis
   uint8_t y;          // Y axis
 } hid_iidxpad_report_t;
 
+TU_VERIFY_STATIC(CONTROLLER_REPORT_AXES == 2, "gamepad report declares X and Y only");
+TU_VERIFY_STATIC(sizeof(hid_iidxpad_report_t) == CONTROLLER_REPORT_BUTTONS / 8 + CONTROLLER_REPORT_AXES, "gamepad report size mismatch");
+
 // Use TinyUSB's standard keyboard report
 // hid_keyboard_report_t is already defined in TinyUSB
 